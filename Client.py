@@ -1,5 +1,8 @@
+import os
 import sys
 import json
+import zlib
+import base64
 import socket
 import threading
 from PyQt5.QtWidgets import (QApplication, QMainWindow, QWidget, QVBoxLayout, QHBoxLayout, 
@@ -7,6 +10,19 @@ from PyQt5.QtWidgets import (QApplication, QMainWindow, QWidget, QVBoxLayout, QH
                              QTabWidget, QMessageBox, QInputDialog)
 from PyQt5.QtCore import Qt, pyqtSignal, QObject, QTimer
 
+# Последний полученный id сообщения для каждого пользователя и сервера
+STATE_FILE = os.path.join(os.path.expanduser("~"), ".chat_client_state.json")
+
+# Словарь для сжатия ответов сервера, должен совпадать с COMPRESSION_DICTIONARY в Compression.cpp
+COMPRESSION_ENCODING = "deflate"
+COMPRESSION_DICTIONARY = (
+    b'{"data":{"teams":[{"created_at":"2025-01-01 00:00:00","team_id":"1","team_name":""}],"users":[""]},"type":"chat_list"}'
+    b'{"query":"","results":[{"chat_id":"","content":"","from":"","id":0,"is_team":false,"timestamp":"2025-01-01 00:00:00"}],"type":"search_results"}'
+    b'{"chats":[{"chat_id":"","is_team":false,"messages":[],"unread":0}],"has_more":false,"last_message_id":0,"type":"sync"}'
+    b'{"chat_id":"","is_team":false,"messages":[{"content":"","from":"","id":0,"timestamp":"2025-01-01 00:00:00"},'
+    b'{"content":"","from":"","id":0,"timestamp":"2025-01-01 00:00:00"}],"type":"chat_messages"}'
+)
+
 class SignalEmitter(QObject):
     message_received = pyqtSignal(dict)
     auth_result = pyqtSignal(dict)
@@ -15,6 +31,8 @@ class SignalEmitter(QObject):
     team_created = pyqtSignal(dict)
     user_added = pyqtSignal(dict)
     chat_list_received = pyqtSignal(dict)
+    search_results = pyqtSignal(dict)
+    sync_received = pyqtSignal(dict)
 
 class ChatClient:
     def __init__(self, host, port):
@@ -23,6 +41,9 @@ class ChatClient:
         self.socket = None
         self.connected = False
         self.username = ""
+        self.last_message_id = 0
+        self.syncing = False
+        self.live_message_id = 0
         self.signal_emitter = SignalEmitter()
         
     def connect(self):
@@ -60,10 +81,54 @@ class ChatClient:
                 self.disconnect()
                 break
     
+    def state_key(self):
+        return f"{self.username}@{self.host}:{self.port}"
+    
+    def read_state(self):
+        try:
+            with open(STATE_FILE, encoding='utf-8') as f:
+                state = json.load(f)
+            return state if isinstance(state, dict) else {}
+        except (OSError, ValueError):
+            return {}
+    
+    def load_last_message_id(self):
+        self.last_message_id = self.read_state().get(self.state_key(), 0)
+        self.syncing = False
+        self.live_message_id = 0
+    
+    def save_last_message_id(self):
+        state = self.read_state()
+        state[self.state_key()] = self.last_message_id
+        try:
+            temp_file = STATE_FILE + ".tmp"
+            with open(temp_file, 'w', encoding='utf-8') as f:
+                json.dump(state, f)
+            os.replace(temp_file, STATE_FILE)
+        except OSError as e:
+            print(f"State save error: {e}")
+    
+    def update_last_message_id(self, message_id):
+        if message_id and message_id > self.last_message_id:
+            self.last_message_id = message_id
+            self.save_last_message_id()
+    
     def handle_server_message(self, msg):
         msg_type = msg.get("type")
         
-        if msg_type in ["message", "team_message"]:
+        if msg_type == "compressed":
+            if msg.get("encoding") != COMPRESSION_ENCODING:
+                print(f"Unsupported encoding: {msg.get('encoding')}")
+                return
+            decompressor = zlib.decompressobj(zdict=COMPRESSION_DICTIONARY)
+            data = decompressor.decompress(base64.b64decode(msg["data"]))
+            self.handle_server_message(json.loads(data.decode('utf-8')))
+        elif msg_type in ["message", "team_message"]:
+            # Во время синхронизации отметку не сдвигаем, иначе следующая страница пропустит сообщения
+            if self.syncing:
+                self.live_message_id = max(self.live_message_id, msg.get("id") or 0)
+            else:
+                self.update_last_message_id(msg.get("id"))
             self.signal_emitter.message_received.emit(msg)
         elif msg_type == "auth_response":
             self.signal_emitter.auth_result.emit(msg)
@@ -77,6 +142,17 @@ class ChatClient:
             self.signal_emitter.user_added.emit(msg)
         elif msg_type == "chat_list":
             self.signal_emitter.chat_list_received.emit(msg)
+        elif msg_type == "search_results":
+            self.signal_emitter.search_results.emit(msg)
+        elif msg_type == "sync":
+            if msg.get("has_more"):
+                # Следующая страница запрашивается от курсора из ответа
+                self.sync(msg.get("last_message_id"))
+            else:
+                self.syncing = False
+                self.update_last_message_id(max(msg.get("last_message_id") or 0, self.live_message_id))
+                self.live_message_id = 0
+            self.signal_emitter.sync_received.emit(msg)
         elif msg_type == "error":
             print(f"Server error: {msg.get('message', 'Unknown error')}")
     
@@ -96,7 +172,8 @@ class ChatClient:
         msg = {
             "type": "auth",
             "username": username,
-            "password_hash": password_hash
+            "password_hash": password_hash,
+            "compression": [COMPRESSION_ENCODING]
         }
         return self.send_message(msg)
     
@@ -145,6 +222,24 @@ class ChatClient:
         }
         return self.send_message(msg)
     
+    def sync(self, cursor=None):
+        self.syncing = True
+        msg = {
+            "type": "sync",
+            "last_message_id": self.last_message_id if cursor is None else cursor
+        }
+        return self.send_message(msg)
+    
+    def search_messages(self, query, chat_id=None, is_team=False):
+        msg = {
+            "type": "search_messages",
+            "query": query
+        }
+        if chat_id:
+            msg["chat_id"] = chat_id
+            msg["is_team"] = is_team
+        return self.send_message(msg)
+    
     def disconnect(self):
         if self.connected:
             self.connected = False
@@ -234,6 +329,7 @@ class LoginWindow(QWidget):
     def handle_auth_result(self, response):
         if response.get("status") == "success":
             self.client.username = response.get("username", "")
+            self.client.load_last_message_id()
             self.close()
             self.chat_window = ChatWindow(self.client)
             self.chat_window.show()
@@ -260,6 +356,7 @@ class ChatWindow(QMainWindow):
         self.client = client
         self.current_chat = None
         self.current_chat_is_team = False
+        self.unread = {}
         self.init_ui()
         
         self.client.signal_emitter.message_received.connect(self.handle_message)
@@ -267,12 +364,15 @@ class ChatWindow(QMainWindow):
         self.client.signal_emitter.team_created.connect(self.handle_team_created)
         self.client.signal_emitter.user_added.connect(self.handle_user_added)
         self.client.signal_emitter.chat_list_received.connect(self.handle_chat_list)
+        self.client.signal_emitter.search_results.connect(self.handle_search_results)
+        self.client.signal_emitter.sync_received.connect(self.handle_sync)
         
         self.update_timer = QTimer()
         self.update_timer.timeout.connect(self.load_chat_list)
         self.update_timer.start(30000)
         
         self.load_chat_list()
+        self.client.sync()
     
     def init_ui(self):
         self.setWindowTitle(f'Чат - {self.client.username}')
@@ -287,6 +387,11 @@ class ChatWindow(QMainWindow):
         left_panel = QVBoxLayout()
         left_panel.setContentsMargins(0, 0, 0, 0)
         
+        self.search_input = QLineEdit()
+        self.search_input.setPlaceholderText('Поиск по сообщениям...')
+        self.search_input.returnPressed.connect(self.search_messages)
+        left_panel.addWidget(self.search_input)
+        
         self.tabs = QTabWidget()
         
         self.users_tab = QWidget()
@@ -370,10 +475,42 @@ class ChatWindow(QMainWindow):
             items = self.teams_list.findItems(current_team, Qt.MatchExactly)
             if items:
                 self.teams_list.setCurrentItem(items[0])
+        
+        self.update_unread_marks()
+    
+    def update_unread_marks(self):
+        for chat_list, is_team in ((self.users_list, False), (self.teams_list, True)):
+            for i in range(chat_list.count()):
+                item = chat_list.item(i)
+                font = item.font()
+                font.setBold(self.unread.get((item.text(), is_team), 0) > 0)
+                item.setFont(font)
+    
+    def add_unread(self, chat_id, is_team, count=1):
+        if chat_id == self.current_chat and is_team == self.current_chat_is_team:
+            return
+        key = (chat_id, is_team)
+        self.unread[key] = self.unread.get(key, 0) + count
+        self.update_unread_marks()
+    
+    def handle_sync(self, msg):
+        for chat in msg.get("chats", []):
+            chat_id = chat["chat_id"]
+            is_team = chat["is_team"]
+            if chat_id == self.current_chat and is_team == self.current_chat_is_team:
+                for message in chat["messages"]:
+                    if message["from"] == self.client.username:
+                        self.display_message(message["content"])
+                    else:
+                        self.display_message(message["from"], message["content"])
+            elif chat["unread"] > 0:
+                self.add_unread(chat_id, is_team, chat["unread"])
     
     def user_selected(self, item):
         self.current_chat = item.text()
         self.current_chat_is_team = False
+        self.unread.pop((self.current_chat, False), None)
+        self.update_unread_marks()
         self.chat_label.setText(f'Чат с {self.current_chat}')
         self.chat_display.clear()
         self.client.get_chat_history(self.current_chat, False)
@@ -382,6 +519,8 @@ class ChatWindow(QMainWindow):
     def team_selected(self, item):
         self.current_chat = item.text()
         self.current_chat_is_team = True
+        self.unread.pop((self.current_chat, True), None)
+        self.update_unread_marks()
         self.chat_label.setText(f'Группа: {self.current_chat}')
         self.chat_display.clear()
         self.client.get_chat_history(self.current_chat, True)
@@ -407,9 +546,13 @@ class ChatWindow(QMainWindow):
                 self.display_message(msg["from"], msg["content"])
             elif (msg["to"] == self.current_chat and msg["from"] == self.client.username and not self.current_chat_is_team):
                 self.display_message(msg["content"])
+            elif msg["from"] != self.client.username:
+                self.add_unread(msg["from"], False)
         elif msg["type"] == "team_message":
             if msg["to"] == self.current_chat and self.current_chat_is_team:
                 self.display_message(f"{msg['from']}", msg["content"])
+            elif msg["from"] != self.client.username:
+                self.add_unread(msg["to"], True)
     
     def display_message(self, *args):
         if len(args) == 1:
@@ -430,6 +573,23 @@ class ChatWindow(QMainWindow):
                     else:
                         self.display_message(sender, content)
     
+    def search_messages(self):
+        query = self.search_input.text().strip()
+        if query:
+            self.client.search_messages(query)
+    
+    def handle_search_results(self, msg):
+        self.current_chat = None
+        self.invite_button.setEnabled(False)
+        self.chat_label.setText(f'Поиск: {msg.get("query", "")}')
+        self.chat_display.clear()
+        results = msg.get("results", [])
+        if not results:
+            self.display_message('Ничего не найдено')
+        for result in results:
+            chat = f'группа {result["chat_id"]}' if result["is_team"] else result["chat_id"]
+            self.display_message(f'[{chat}, {result["timestamp"]}] {result["from"]}', result["content"])
+    
     def handle_create_team(self):
         team_name, ok = QInputDialog.getText(
             self, 'Создание группы', 'Введите название группы:'
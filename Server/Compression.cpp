@@ -0,0 +1,74 @@
+#include "Compression.hpp"
+#include <stdexcept>
+#include <zlib.h>
+
+const string COMPRESSION_ENCODING = "deflate";
+
+//      
+const size_t COMPRESSION_THRESHOLD = 1024;
+
+//      (    Client.py).
+//   JSON     
+static const string COMPRESSION_DICTIONARY =
+    R"({"data":{"teams":[{"created_at":"2025-01-01 00:00:00","team_id":"1","team_name":""}],"users":[""]},"type":"chat_list"})"
+    R"({"query":"","results":[{"chat_id":"","content":"","from":"","id":0,"is_team":false,"timestamp":"2025-01-01 00:00:00"}],"type":"search_results"})"
+    R"({"chats":[{"chat_id":"","is_team":false,"messages":[],"unread":0}],"has_more":false,"last_message_id":0,"type":"sync"})"
+    R"({"chat_id":"","is_team":false,"messages":[{"content":"","from":"","id":0,"timestamp":"2025-01-01 00:00:00"},)"
+    R"({"content":"","from":"","id":0,"timestamp":"2025-01-01 00:00:00"}],"type":"chat_messages"})";
+
+//     zlib   
+string compress_deflate(const string& data) {
+    z_stream stream{};
+    if (deflateInit(&stream, Z_BEST_SPEED) != Z_OK) {
+        throw runtime_error("  zlib");
+    }
+
+    deflateSetDictionary(&stream,
+        reinterpret_cast<const Bytef*>(COMPRESSION_DICTIONARY.data()),
+        static_cast<uInt>(COMPRESSION_DICTIONARY.size()));
+
+    string compressed(deflateBound(&stream, static_cast<uLong>(data.size())), '\0');
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    stream.avail_in = static_cast<uInt>(data.size());
+    stream.next_out = reinterpret_cast<Bytef*>(&compressed[0]);
+    stream.avail_out = static_cast<uInt>(compressed.size());
+
+    int result = deflate(&stream, Z_FINISH);
+    compressed.resize(stream.total_out);
+    deflateEnd(&stream);
+
+    if (result != Z_STREAM_END) {
+        throw runtime_error("  ");
+    }
+    return compressed;
+}
+
+//   base64,       '\0'
+string base64_encode(const string& data) {
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    string encoded;
+    encoded.reserve((data.size() + 2) / 3 * 4);
+
+    size_t i = 0;
+    for (; i + 2 < data.size(); i += 3) {
+        unsigned int chunk = (static_cast<unsigned char>(data[i]) << 16)
+            | (static_cast<unsigned char>(data[i + 1]) << 8)
+            | static_cast<unsigned char>(data[i + 2]);
+        encoded += alphabet[(chunk >> 18) & 0x3F];
+        encoded += alphabet[(chunk >> 12) & 0x3F];
+        encoded += alphabet[(chunk >> 6) & 0x3F];
+        encoded += alphabet[chunk & 0x3F];
+    }
+
+    if (i < data.size()) {
+        unsigned int chunk = static_cast<unsigned char>(data[i]) << 16;
+        if (i + 1 < data.size()) {
+            chunk |= static_cast<unsigned char>(data[i + 1]) << 8;
+        }
+        encoded += alphabet[(chunk >> 18) & 0x3F];
+        encoded += alphabet[(chunk >> 12) & 0x3F];
+        encoded += i + 1 < data.size() ? alphabet[(chunk >> 6) & 0x3F] : '=';
+        encoded += '=';
+    }
+    return encoded;
+}
@@ -0,0 +1,11 @@
+#pragma once
+#include <string>
+
+using namespace std;
+
+//    (deflate   ,    )
+extern const string COMPRESSION_ENCODING;
+extern const size_t COMPRESSION_THRESHOLD;
+
+string compress_deflate(const string& data);
+string base64_encode(const string& data);
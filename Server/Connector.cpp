@@ -2,10 +2,12 @@
 
 Connector::Connector(io_context& io_context,
     unsigned int port,
-    DatabaseHandler& db_handler)
+    DatabaseHandler& db_handler,
+    SearchIndex& search_index)
     : io_context_(io_context),                                      //   -
     acceptor_(io_context, ip::tcp::endpoint(ip::tcp::v4(), port)),  //  
-    db_handler_(db_handler) {                                       //   
+    db_handler_(db_handler),                                        //   
+    search_index_(search_index) {                                   //   
     start_accept();                                                 //   
 }
 
@@ -25,7 +27,7 @@ void Connector::handle_accept(shared_ptr<ip::tcp::socket> socket, const boost::s
         cout << "  : " << socket->remote_endpoint().address().to_string() << endl;
 
         //     
-        auto session = make_shared<Session>(socket, db_handler_);
+        auto session = make_shared<Session>(socket, db_handler_, search_index_);
         session->set_connector(shared_from_this());
         add_session(session);
         session->start();
@@ -50,11 +52,12 @@ void Connector::remove_session(shared_ptr<Session> session) {
     sessions_.erase(session);                   
 }
 
-void Connector::broadcast_message(const string& from, const string& target, const string& content, bool is_team){
+void Connector::broadcast_message(long long id, const string& from, const string& target, const string& content, bool is_team){
     //  JSON-
     lock_guard<mutex> lock(sessions_mutex_);
     json message = {
         {"type", is_team ? "team_message" : "message"},
+        {"id", id},
         {"from", from},                 
         {"to", target},
         {"content", content},          
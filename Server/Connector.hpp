@@ -3,6 +3,7 @@
 #include <memory>
 #include <unordered_set>
 #include "DatabaseHandler.hpp"
+#include "SearchIndex.hpp"
 #include "Session.hpp"
 
 class Connector : public enable_shared_from_this<Connector> {
@@ -10,14 +11,15 @@ private:
     io_context& io_context_;
     ip::tcp::acceptor acceptor_;
     DatabaseHandler& db_handler_;
+    SearchIndex& search_index_;
     unordered_set<shared_ptr<Session>> sessions_;
     mutex sessions_mutex_;
     void start_accept();
     void handle_accept(shared_ptr<ip::tcp::socket> socket, const boost::system::error_code& error);
 
 public:
-    Connector(io_context& io_context, unsigned int port, DatabaseHandler& db_handler);
-    void broadcast_message(const string& from, const string& to, const string& content, bool is_team);
+    Connector(io_context& io_context, unsigned int port, DatabaseHandler& db_handler, SearchIndex& search_index);
+    void broadcast_message(long long id, const string& from, const string& to, const string& content, bool is_team);
     void add_session(shared_ptr<Session> session);
     void remove_session(shared_ptr<Session> session);
 };
\ No newline at end of file
@@ -120,21 +120,45 @@ bool DatabaseHandler::authenticate_user(const string& username, const string& pa
     return auth_success;
 }
 
-void DatabaseHandler::save_message(const string& from, const string& to, const string& content, bool is_team) {
+long long DatabaseHandler::save_message(const string& from, const string& to, const string& content, bool is_team) {
     string query;
 
+    //   SELECT:      ,   
     if (is_team) {
         query = "INSERT INTO messages (sender_id, team_id, content) "
-            "VALUES ((SELECT id FROM users WHERE username = '" + from + "'), "
-            "(SELECT id FROM team WHERE name = '" + to + "'), '" + content + "')";
+            "SELECT s.id, g.id, '" + content + "' FROM users s, team g "
+            "WHERE s.username = '" + from + "' AND g.name = '" + to + "' LIMIT 1";
     }
     else {
         query = "INSERT INTO messages (sender_id, receiver_id, content) "
-            "VALUES ((SELECT id FROM users WHERE username = '" + from + "'), "
-            "(SELECT id FROM users WHERE username = '" + to + "'), "
-            "'" + content + "')";
+            "SELECT s.id, r.id, '" + content + "' FROM users s, users r "
+            "WHERE s.username = '" + from + "' AND r.username = '" + to + "' LIMIT 1";
     }
-    execute_query(query);
+    if (!execute_query(query) || mysql_affected_rows(connection_) == 0) {
+        return 0;
+    }
+    return static_cast<long long>(mysql_insert_id(connection_));
+}
+
+//  ,   
+string DatabaseHandler::get_message_timestamp(long long id) {
+    string timestamp;
+    string query = "SELECT timestamp FROM messages WHERE id = " + to_string(id);
+    if (!execute_query(query))
+        return timestamp;
+
+    MYSQL_RES* result = mysql_store_result(connection_);
+    if (!result) {
+        return timestamp;
+    }
+
+    MYSQL_ROW row = mysql_fetch_row(result);
+    if (row && row[0]) {
+        timestamp = row[0];
+    }
+
+    mysql_free_result(result);
+    return timestamp;
 }
 
 bool DatabaseHandler::create_team(const string& team_name, const string& creator_username) {
@@ -242,7 +266,7 @@ json DatabaseHandler::get_chat_messages(const string& username, const string& ch
     string query;
     if (is_team) {
         query =
-            "SELECT u.username as sender, m.content, m.timestamp "
+            "SELECT u.username as sender, m.content, m.timestamp, m.id "
             "FROM messages m "
             "JOIN users u ON m.sender_id = u.id "
             "WHERE m.team_id = (SELECT id FROM team WHERE name = '" + chat_id + "')  "
@@ -250,7 +274,7 @@ json DatabaseHandler::get_chat_messages(const string& username, const string& ch
     }
     else {
         query =
-        "SELECT u.username as sender, m.content, m.timestamp "
+        "SELECT u.username as sender, m.content, m.timestamp, m.id "
             "FROM messages m "
             "JOIN users u ON m.sender_id = u.id "
             "WHERE (m.sender_id = (SELECT id FROM users WHERE username = '" + username + "') "
@@ -273,11 +297,130 @@ json DatabaseHandler::get_chat_messages(const string& username, const string& ch
         json message = {
             {"from", row[0]},
             {"content", row[1]},
-            {"timestamp", row[2]}
+            {"timestamp", row[2]},
+            {"id", stoll(row[3])}
+        };
+        messages.push_back(message);
+    }
+
+    mysql_free_result(result);
+    return messages;
+};
+
+//        (   )
+json DatabaseHandler::fetch_messages(const string& condition, const string& limit) {
+    json messages = json::array();
+
+    string query =
+        "SELECT m.id, s.username, r.username, t.name, m.content, m.timestamp "
+        "FROM messages m "
+        "JOIN users s ON m.sender_id = s.id "
+        "LEFT JOIN users r ON m.receiver_id = r.id "
+        "LEFT JOIN team t ON m.team_id = t.id "
+        "WHERE (" + condition + ") "
+        //        LIMIT
+        "AND (r.username IS NOT NULL OR t.name IS NOT NULL) "
+        "ORDER BY m.id ASC" + limit;
+
+    if (!execute_query(query)) {
+        return messages;
+    }
+
+    MYSQL_RES* result = mysql_store_result(connection_);
+    if (!result) return messages;
+
+    MYSQL_ROW row;
+    while ((row = mysql_fetch_row(result))) {
+        bool is_team = row[3] != nullptr;
+        json message = {
+            {"id", stoll(row[0])},
+            {"from", row[1]},
+            {"to", is_team ? row[3] : row[2]},
+            {"is_team", is_team},
+            {"content", row[4]},
+            {"timestamp", row[5] ? row[5] : ""}
         };
         messages.push_back(message);
     }
 
     mysql_free_result(result);
     return messages;
-};
\ No newline at end of file
+}
+
+//     id   (   )
+json DatabaseHandler::load_messages(long long after_id) {
+    return fetch_messages("m.id > " + to_string(after_id));
+}
+
+//            after_id
+json DatabaseHandler::get_new_messages(const string& username, long long after_id, size_t limit) {
+    string condition = "m.id > " + to_string(after_id) + " AND " + user_chats_condition(username);
+    return fetch_messages(condition, " LIMIT " + to_string(limit));
+}
+
+//       
+string DatabaseHandler::user_chats_condition(const string& username) {
+    return
+        "(s.username = '" + username + "' "
+        "OR r.username = '" + username + "' "
+        "OR m.team_id IN (SELECT gm.team_id FROM team_members gm "
+        "JOIN users u ON gm.user_id = u.id "
+        "WHERE u.username = '" + username + "'))";
+}
+
+//        (  )
+json DatabaseHandler::get_unread_counts(const string& username, long long up_to_id) {
+    json chats = json::array();
+
+    string query =
+        "SELECT COALESCE(t.name, s.username) AS chat_id, t.name IS NOT NULL AS is_team, COUNT(*) "
+        "FROM messages m "
+        "JOIN users s ON m.sender_id = s.id "
+        "LEFT JOIN users r ON m.receiver_id = r.id "
+        "LEFT JOIN team t ON m.team_id = t.id "
+        "WHERE m.id <= " + to_string(up_to_id) + " "
+        "AND s.username <> '" + username + "' "
+        "AND (r.username IS NOT NULL OR t.name IS NOT NULL) "
+        "AND " + user_chats_condition(username) + " "
+        "GROUP BY chat_id, is_team";
+
+    if (!execute_query(query)) {
+        return chats;
+    }
+
+    MYSQL_RES* result = mysql_store_result(connection_);
+    if (!result) return chats;
+
+    MYSQL_ROW row;
+    while ((row = mysql_fetch_row(result))) {
+        json chat = {
+            {"chat_id", row[0]},
+            {"is_team", string(row[1]) == "1"},
+            {"unread", stoll(row[2])}
+        };
+        chats.push_back(chat);
+    }
+
+    mysql_free_result(result);
+    return chats;
+}
+
+//  id  (   )
+long long DatabaseHandler::get_last_message_id() {
+    long long last_id = 0;
+    if (!execute_query("SELECT MAX(id) FROM messages"))
+        return last_id;
+
+    MYSQL_RES* result = mysql_store_result(connection_);
+    if (!result) {
+        return last_id;
+    }
+
+    MYSQL_ROW row = mysql_fetch_row(result);
+    if (row && row[0]) {
+        last_id = stoll(row[0]);
+    }
+
+    mysql_free_result(result);
+    return last_id;
+}
\ No newline at end of file
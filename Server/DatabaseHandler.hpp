@@ -17,6 +17,8 @@ private:
     string database_;
     unsigned int port_;
     bool initialize_db();
+    json fetch_messages(const string& condition, const string& limit = "");
+    static string user_chats_condition(const string& username);
 
 public:
     MYSQL* connection_;
@@ -25,8 +27,13 @@ public:
     bool connect();
     bool authenticate_user(const string& username, const string& password_hash);
     string register_user(const string& username, const string& password_hash);
-    void save_message(const string& from, const string& to, const string& content, bool is_team);
+    long long save_message(const string& from, const string& to, const string& content, bool is_team);
+    string get_message_timestamp(long long id);
     json get_chat_messages(const string& username, const string& chat_id, bool is_team);
+    json load_messages(long long after_id);
+    json get_new_messages(const string& username, long long after_id, size_t limit);
+    long long get_last_message_id();
+    json get_unread_counts(const string& username, long long up_to_id);
     bool create_team(const string& team_name, const string& creator_username);
     bool add_user_to_team(const string& username, const string& team_name);
     json get_team_members(const string& team_name);
@@ -0,0 +1,472 @@
+#include "SearchIndex.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+namespace fs = std::filesystem;
+
+namespace {
+    const char SEGMENT_MAGIC[4] = { 'K', 'S', 'E', 'G' };
+    const uint32_t SEGMENT_VERSION = 2;
+    const char MANIFEST_FILE[] = "index.manifest";
+
+    //     (FNV-1a   )
+    string segment_file_name(const string& key) {
+        uint64_t hash = 14695981039346656037ull;
+        for (unsigned char c : key) {
+            hash ^= c;
+            hash *= 1099511628211ull;
+        }
+        char name[32];
+        snprintf(name, sizeof(name), "%016llx.seg", static_cast<unsigned long long>(hash));
+        return name;
+    }
+
+    void append_utf8(string& out, uint32_t cp) {
+        if (cp < 0x80) {
+            out += static_cast<char>(cp);
+        }
+        else if (cp < 0x800) {
+            out += static_cast<char>(0xC0 | (cp >> 6));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+        else if (cp < 0x10000) {
+            out += static_cast<char>(0xE0 | (cp >> 12));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+        else {
+            out += static_cast<char>(0xF0 | (cp >> 18));
+            out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+    }
+
+    //      ,  - 
+    bool is_word_char(uint32_t cp) {
+        if (cp < 0x80) {
+            return (cp >= '0' && cp <= '9') || (cp >= 'a' && cp <= 'z') || (cp >= 'A' && cp <= 'Z');
+        }
+        if (cp < 0xC0 || cp == 0xD7 || cp == 0xF7) return false;
+        if (cp >= 0x2000 && cp <= 0x206F) return false;     //  
+        if (cp >= 0x3000 && cp <= 0x303F) return false;
+        return true;
+    }
+
+    uint32_t to_lower(uint32_t cp) {
+        if (cp >= 'A' && cp <= 'Z') return cp + 0x20;
+        if (cp >= 0xC0 && cp <= 0xDE && cp != 0xD7) return cp + 0x20;
+        if (cp >= 0x410 && cp <= 0x42F) return cp + 0x20;   // -
+        if (cp >= 0x400 && cp <= 0x40F) return cp + 0x50;   //   .
+        return cp;
+    }
+
+    template <typename T>
+    void write_value(ofstream& out, T value) {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void write_string(ofstream& out, const string& value) {
+        write_value<uint32_t>(out, static_cast<uint32_t>(value.size()));
+        out.write(value.data(), value.size());
+    }
+
+    template <typename T>
+    bool read_value(ifstream& in, T& value) {
+        return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(value)));
+    }
+
+    bool read_string(ifstream& in, string& value) {
+        uint32_t size;
+        if (!read_value(in, size) || size > (64u << 20)) return false;
+        value.resize(size);
+        return size == 0 || static_cast<bool>(in.read(&value[0], size));
+    }
+}
+
+SearchIndex::SearchIndex(const string& directory)
+    : directory_(directory) {
+}
+
+//  :   ,      
+string SearchIndex::segment_key(const string& from, const string& to, bool is_team) {
+    if (is_team) {
+        return "t:" + to;
+    }
+    return from < to ? "d:" + from + '\n' + to : "d:" + to + '\n' + from;
+}
+
+//   UTF-8     
+vector<string> SearchIndex::tokenize(const string& text) {
+    vector<string> tokens;
+    string token;
+    size_t i = 0;
+    while (i < text.size()) {
+        unsigned char c = text[i];
+        uint32_t cp = 0;
+        size_t length = 1;
+        if (c < 0x80) { cp = c; }
+        else if ((c & 0xE0) == 0xC0) { cp = c & 0x1F; length = 2; }
+        else if ((c & 0xF0) == 0xE0) { cp = c & 0x0F; length = 3; }
+        else if ((c & 0xF8) == 0xF0) { cp = c & 0x07; length = 4; }
+
+        if (i + length > text.size()) {
+            cp = 0;
+            length = 1;
+        }
+        else {
+            for (size_t k = 1; k < length; ++k) {
+                cp = (cp << 6) | (static_cast<unsigned char>(text[i + k]) & 0x3F);
+            }
+        }
+        i += length;
+
+        if (is_word_char(cp)) {
+            append_utf8(token, to_lower(cp));
+        }
+        else if (!token.empty()) {
+            tokens.push_back(move(token));
+            token.clear();
+        }
+    }
+    if (!token.empty()) {
+        tokens.push_back(move(token));
+    }
+    return tokens;
+}
+
+void SearchIndex::index_document(Segment& segment, uint32_t position) {
+    vector<string> tokens = tokenize(segment.documents[position].content);
+    sort(tokens.begin(), tokens.end());
+    tokens.erase(unique(tokens.begin(), tokens.end()), tokens.end());
+    for (const auto& token : tokens) {
+        segment.postings[token].push_back(position);
+    }
+}
+
+void SearchIndex::add_locked(long long id, const string& from, const string& to, const string& content, const string& timestamp, bool is_team) {
+    string key = segment_key(from, to, is_team);
+    Segment& segment = segments_[key];
+    if (segment.documents.empty()) {
+        segment.is_team = is_team;
+        if (is_team) {
+            segment.first = to;
+        }
+        else {
+            segment.first = min(from, to);
+            segment.second = max(from, to);
+        }
+    }
+
+    segment.documents.push_back({ id, from, content, timestamp });
+    index_document(segment, static_cast<uint32_t>(segment.documents.size() - 1));
+    max_id_ = max(max_id_, id);
+}
+
+//     
+void SearchIndex::add_message(long long id, const string& from, const string& to, const string& content, const string& timestamp, bool is_team) {
+    lock_guard<mutex> lock(index_mutex_);
+    add_locked(id, from, to, content, timestamp, is_team);
+}
+
+//    :    +   ,    
+void SearchIndex::build(DatabaseHandler& db_handler) {
+    {
+        lock_guard<mutex> lock(index_mutex_);
+        if (!load()) {
+            cerr << "  ,    " << endl;
+            segments_.clear();
+            max_id_ = 0;
+            watermark_ = 0;
+        }
+
+        //    : ,   ,    
+        json rows = db_handler.load_messages(watermark_);
+        size_t added = 0;
+        for (const auto& row : rows) {
+            long long id = row["id"];
+            auto it = segments_.find(segment_key(row["from"], row["to"], row["is_team"]));
+            if (it != segments_.end() && !it->second.documents.empty() && id <= it->second.documents.back().id) {
+                continue;
+            }
+            add_locked(id, row["from"], row["to"], row["content"], row["timestamp"], row["is_team"]);
+            ++added;
+        }
+        cout << " :  " << segments_.size()
+            << ",     " << added << endl;
+    }
+    save();
+}
+
+//  ,     (    )
+json SearchIndex::search(const string& username, const unordered_set<string>& teams, const string& query,
+    const string& chat_id, bool is_team, size_t limit) {
+    json results = json::array();
+    vector<string> terms = tokenize(query);
+    if (terms.empty() || limit == 0) {
+        return results;
+    }
+
+    struct Hit {
+        const Segment* segment;
+        const Document* document;
+    };
+    vector<Hit> hits;
+
+    lock_guard<mutex> lock(index_mutex_);
+
+    auto search_segment = [&](const Segment& segment) {
+        //        ,   
+        if (segment.is_team ? teams.count(segment.first) == 0
+            : segment.first != username && segment.second != username) {
+            return;
+        }
+
+        vector<uint32_t> matches;
+        for (size_t i = 0; i < terms.size(); ++i) {
+            const string& term = terms[i];
+            vector<uint32_t> term_matches;
+            size_t matched_terms = 0;
+            for (auto it = segment.postings.lower_bound(term);
+                it != segment.postings.end() && it->first.compare(0, term.size(), term) == 0; ++it) {
+                term_matches.insert(term_matches.end(), it->second.begin(), it->second.end());
+                ++matched_terms;
+            }
+            if (matched_terms > 1) {
+                sort(term_matches.begin(), term_matches.end());
+                term_matches.erase(unique(term_matches.begin(), term_matches.end()), term_matches.end());
+            }
+
+            if (i == 0) {
+                matches = move(term_matches);
+            }
+            else {
+                vector<uint32_t> intersection;
+                set_intersection(matches.begin(), matches.end(),
+                    term_matches.begin(), term_matches.end(), back_inserter(intersection));
+                matches = move(intersection);
+            }
+            if (matches.empty()) return;
+        }
+
+        for (uint32_t position : matches) {
+            hits.push_back({ &segment, &segment.documents[position] });
+        }
+    };
+
+    if (!chat_id.empty()) {
+        auto it = segments_.find(segment_key(username, chat_id, is_team));
+        if (it != segments_.end()) {
+            search_segment(it->second);
+        }
+    }
+    else {
+        for (const auto& [key, segment] : segments_) {
+            search_segment(segment);
+        }
+    }
+
+    //    
+    auto newest_first = [](const Hit& a, const Hit& b) { return a.document->id > b.document->id; };
+    if (hits.size() > limit) {
+        partial_sort(hits.begin(), hits.begin() + limit, hits.end(), newest_first);
+        hits.resize(limit);
+    }
+    else {
+        sort(hits.begin(), hits.end(), newest_first);
+    }
+
+    for (const auto& hit : hits) {
+        const Segment& segment = *hit.segment;
+        results.push_back({
+            {"id", hit.document->id},
+            {"chat_id", segment.is_team || segment.first != username ? segment.first : segment.second},
+            {"is_team", segment.is_team},
+            {"from", hit.document->from},
+            {"content", hit.document->content},
+            {"timestamp", hit.document->timestamp}
+        });
+    }
+    return results;
+}
+
+//      
+void SearchIndex::save() {
+    lock_guard<mutex> lock(index_mutex_);
+    error_code ec;
+    fs::create_directories(directory_, ec);
+    if (ec) {
+        cerr << "   : " << ec.message() << endl;
+        return;
+    }
+
+    bool complete = true;
+    for (auto& [key, segment] : segments_) {
+        if (segment.persisted < segment.documents.size() && !append_segment(key, segment)) {
+            complete = false;
+        }
+    }
+
+    //     ,    
+    if (complete && max_id_ != watermark_ && save_manifest(max_id_)) {
+        watermark_ = max_id_;
+    }
+}
+
+bool SearchIndex::save_manifest(long long watermark) {
+    fs::path path = fs::path(directory_) / MANIFEST_FILE;
+    fs::path temp_path = path;
+    temp_path += ".tmp";
+
+    {
+        ofstream out(temp_path, ios::trunc);
+        out << watermark << '\n';
+        if (!out) {
+            cerr << "   : " << temp_path.string() << endl;
+            return false;
+        }
+    }
+
+    error_code ec;
+    fs::rename(temp_path, path, ec);
+    if (ec) {
+        cerr << "   : " << ec.message() << endl;
+        return false;
+    }
+    return true;
+}
+
+//       
+bool SearchIndex::append_segment(const string& key, Segment& segment) {
+    fs::path path = fs::path(directory_) / segment_file_name(key);
+    bool fresh = segment.persisted == 0;
+
+    error_code ec;
+    uintmax_t size = fs::file_size(path, ec);
+    if (ec) {
+        fresh = true;
+    }
+    else if (!fresh && size != segment.persisted_bytes) {
+        //  ,    
+        fs::resize_file(path, segment.persisted_bytes, ec);
+        if (ec) {
+            cerr << "   : " << ec.message() << endl;
+            return false;
+        }
+    }
+
+    {
+        ofstream out(path, ios::binary | (fresh ? ios::trunc : ios::app));
+        if (!out) {
+            cerr << "   : " << path.string() << endl;
+            return false;
+        }
+
+        if (fresh) {
+            out.write(SEGMENT_MAGIC, sizeof(SEGMENT_MAGIC));
+            write_value<uint32_t>(out, SEGMENT_VERSION);
+            write_value<uint8_t>(out, segment.is_team ? 1 : 0);
+            write_string(out, segment.first);
+            write_string(out, segment.second);
+        }
+
+        for (size_t i = fresh ? 0 : segment.persisted; i < segment.documents.size(); ++i) {
+            const Document& document = segment.documents[i];
+            write_value<int64_t>(out, document.id);
+            write_string(out, document.from);
+            write_string(out, document.timestamp);
+            write_string(out, document.content);
+        }
+
+        if (!out.flush()) {
+            cerr << "   : " << path.string() << endl;
+            return false;
+        }
+    }
+
+    segment.persisted_bytes = fs::file_size(path, ec);
+    if (ec) {
+        segment.persisted = 0;
+        return false;
+    }
+    segment.persisted = segment.documents.size();
+    return true;
+}
+
+bool SearchIndex::load_segment(const string& path) {
+    ifstream in(path, ios::binary);
+    char magic[sizeof(SEGMENT_MAGIC)];
+    uint32_t version;
+    if (!in.read(magic, sizeof(magic)) || !equal(begin(magic), end(magic), SEGMENT_MAGIC)
+        || !read_value(in, version) || version != SEGMENT_VERSION) {
+        return false;
+    }
+
+    Segment segment;
+    uint8_t is_team;
+    if (!read_value(in, is_team) || !read_string(in, segment.first) || !read_string(in, segment.second)) {
+        return false;
+    }
+    segment.is_team = is_team != 0;
+
+    //      ,   
+    uintmax_t valid_bytes = static_cast<uintmax_t>(in.tellg());
+    while (in.peek() != ifstream::traits_type::eof()) {
+        int64_t id;
+        Document document;
+        if (!read_value(in, id) || !read_string(in, document.from)
+            || !read_string(in, document.timestamp) || !read_string(in, document.content)) {
+            break;
+        }
+        document.id = id;
+        max_id_ = max(max_id_, document.id);
+        segment.documents.push_back(move(document));
+        index_document(segment, static_cast<uint32_t>(segment.documents.size() - 1));
+        valid_bytes = static_cast<uintmax_t>(in.tellg());
+    }
+    in.close();
+
+    //    ,      
+    error_code ec;
+    if (fs::file_size(path, ec) != valid_bytes) {
+        fs::resize_file(path, valid_bytes, ec);
+        if (ec) return false;
+        watermark_ = min(watermark_, segment.documents.empty() ? 0 : segment.documents.back().id);
+    }
+    if (segment.documents.empty()) {
+        return true;
+    }
+
+    segment.persisted = segment.documents.size();
+    segment.persisted_bytes = valid_bytes;
+    string key = segment.is_team ? segment_key("", segment.first, true)
+        : segment_key(segment.first, segment.second, false);
+    segments_[key] = move(segment);
+    return true;
+}
+
+//  ,    
+bool SearchIndex::load() {
+    error_code ec;
+    if (!fs::is_directory(directory_, ec)) {
+        return true;
+    }
+
+    //         
+    ifstream manifest(fs::path(directory_) / MANIFEST_FILE);
+    if (manifest && !(manifest >> watermark_)) {
+        return false;
+    }
+
+    for (const auto& entry : fs::directory_iterator(directory_, ec)) {
+        if (entry.path().extension() != ".seg") continue;
+        if (!load_segment(entry.path().string())) {
+            cerr << "   : " << entry.path().string() << endl;
+            return false;
+        }
+    }
+    return !ec;
+}
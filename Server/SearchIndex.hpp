@@ -0,0 +1,56 @@
+#pragma once
+#include <nlohmann/json.hpp>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "DatabaseHandler.hpp"
+
+using json = nlohmann::json;
+using namespace std;
+
+//     .
+//   :      (   )
+class SearchIndex {
+private:
+    struct Document {
+        long long id;
+        string from;
+        string content;
+        string timestamp;
+    };
+
+    struct Segment {
+        bool is_team = false;
+        string first;                           //       
+        string second;                          //    
+        vector<Document> documents;
+        map<string, vector<uint32_t>> postings; //  ->    
+        size_t persisted = 0;                   //       
+        uintmax_t persisted_bytes = 0;          //      
+    };
+
+    mutex index_mutex_;
+    string directory_;
+    map<string, Segment> segments_;
+    long long max_id_ = 0;
+    long long watermark_ = 0;               //    id <= watermark_   
+
+    static string segment_key(const string& from, const string& to, bool is_team);
+    static vector<string> tokenize(const string& text);
+    static void index_document(Segment& segment, uint32_t position);
+    void add_locked(long long id, const string& from, const string& to, const string& content, const string& timestamp, bool is_team);
+    bool load();
+    bool append_segment(const string& key, Segment& segment);
+    bool load_segment(const string& path);
+    bool save_manifest(long long watermark);
+
+public:
+    explicit SearchIndex(const string& directory);
+    void build(DatabaseHandler& db_handler);
+    void add_message(long long id, const string& from, const string& to, const string& content, const string& timestamp, bool is_team);
+    json search(const string& username, const unordered_set<string>& teams, const string& query,
+        const string& chat_id, bool is_team, size_t limit);
+    void save();
+};
@@ -1,8 +1,9 @@
 #include "Session.hpp"
 #include "Connector.hpp"
+#include "Compression.hpp"
 
-Session::Session(shared_ptr<ip::tcp::socket> socket, DatabaseHandler& db_handler)
-    : socket(move(socket)), db_handler_(db_handler) {
+Session::Session(shared_ptr<ip::tcp::socket> socket, DatabaseHandler& db_handler, SearchIndex& search_index)
+    : socket(move(socket)), db_handler_(db_handler), search_index_(search_index) {
 }
 
 void Session::start() {
@@ -41,7 +42,18 @@ void Session::do_read() {
 //   
 void Session::send_response(const json& response) {
     auto self(shared_from_this());
-    auto response_str = make_shared<string>(response.dump() + '\0'); //  
+    string payload = response.dump();
+
+    //   ,    
+    if (compression_ && payload.size() >= COMPRESSION_THRESHOLD) {
+        json compressed = {
+            {"type", "compressed"},
+            {"encoding", COMPRESSION_ENCODING},
+            {"data", base64_encode(compress_deflate(payload))}
+        };
+        payload = compressed.dump();
+    }
+    auto response_str = make_shared<string>(payload + '\0'); //  
 
     //  
     async_write(*socket, buffer(*response_str),
@@ -117,6 +129,14 @@ void Session::process_message(const json& msg) {
         else if (type == "get_chat_list") {
             response = get_available_chats();
         }
+        //         
+        else if (type == "sync") {
+            response = handle_sync(msg);
+        }
+        //   
+        else if (type == "search_messages") {
+            response = handle_search(msg);
+        }
         //  
         else if (type == "message") {
             handle_message(msg, false);
@@ -179,6 +199,18 @@ json Session::handle_auth(const json& msg) {
             {"username", username_},
             {"message", "authorization is successful"}
         };
+
+        //  :     
+        compression_ = false;
+        if (msg.contains("compression") && msg["compression"].is_array()) {
+            for (const auto& encoding : msg["compression"]) {
+                if (encoding == COMPRESSION_ENCODING) {
+                    compression_ = true;
+                    response["compression"] = COMPRESSION_ENCODING;
+                    break;
+                }
+            }
+        }
     }
     else {
         response = {
@@ -194,14 +226,118 @@ json Session::handle_auth(const json& msg) {
 void Session::handle_message(const json& msg, bool is_team) {
     string to = msg["to"];
     string content = msg["content"];
-    //    
-    db_handler_.save_message(username_, to, content, is_team);
+    //         
+    long long id = db_handler_.save_message(username_, to, content, is_team);
+    if (id <= 0) {
+        send_response({
+            {"type", "error"},
+            {"message", is_team ? "Team not found" : "User not found"}
+        });
+        return;
+    }
+    search_index_.add_message(id, username_, to, content, db_handler_.get_message_timestamp(id), is_team);
     //    
     if (auto conn = connector_.lock()) {
-        conn->broadcast_message(username_, to, content, is_team);
+        conn->broadcast_message(id, username_, to, content, is_team);
     }
 }
 
+//      
+json Session::handle_search(const json& msg) {
+    if (!msg.contains("query") || !msg["query"].is_string()) {
+        return {
+            {"type", "error"},
+            {"message", "query is not specified"}
+        };
+    }
+    string query = msg["query"];
+
+    //     
+    string chat_id = msg.value("chat_id", "");
+    bool is_team = msg.value("is_team", false);
+    size_t limit = min<size_t>(msg.value("limit", 50), 200);
+
+    unordered_set<string> teams;
+    for (const auto& team : db_handler_.get_user_team(username_)) {
+        teams.insert(team["team_name"].get<string>());
+    }
+
+    return {
+        {"type", "search_results"},
+        {"query", query},
+        {"results", search_index_.search(username_, teams, query, chat_id, is_team, limit)}
+    };
+}
+
+// :      last_message_id  
+json Session::handle_sync(const json& msg) {
+    const size_t sync_limit = 500;
+    long long last_message_id = msg.value("last_message_id", 0LL);
+
+    //   (    ):  
+    //   ,          
+    if (last_message_id <= 0) {
+        long long last_id = db_handler_.get_last_message_id();
+        json chats = db_handler_.get_unread_counts(username_, last_id);
+        for (auto& chat : chats) {
+            chat["messages"] = json::array();
+        }
+        return {
+            {"type", "sync"},
+            {"last_message_id", last_id},
+            {"has_more", false},
+            {"chats", chats}
+        };
+    }
+
+    //     ,  ,   
+    json rows = db_handler_.get_new_messages(username_, last_message_id, sync_limit + 1);
+    bool has_more = rows.size() > sync_limit;
+    if (has_more) {
+        rows.erase(rows.size() - 1);
+    }
+
+    //    
+    map<pair<string, bool>, json> chats;
+    for (const auto& row : rows) {
+        bool is_team = row["is_team"];
+        string from = row["from"];
+        string chat_id = is_team || from == username_ ? row["to"].get<string>() : from;
+
+        json& chat = chats[{ chat_id, is_team }];
+        if (chat.is_null()) {
+            chat = {
+                {"chat_id", chat_id},
+                {"is_team", is_team},
+                {"unread", 0},
+                {"messages", json::array()}
+            };
+        }
+        if (from != username_) {
+            chat["unread"] = chat["unread"].get<int>() + 1;
+        }
+        chat["messages"].push_back({
+            {"id", row["id"]},
+            {"from", from},
+            {"content", row["content"]},
+            {"timestamp", row["timestamp"]}
+        });
+        last_message_id = row["id"];
+    }
+
+    json chat_list = json::array();
+    for (auto& [key, chat] : chats) {
+        chat_list.push_back(move(chat));
+    }
+
+    return {
+        {"type", "sync"},
+        {"last_message_id", last_message_id},
+        {"has_more", has_more},
+        {"chats", chat_list}
+    };
+}
+
 json Session::get_available_chats() {
     json response;
 
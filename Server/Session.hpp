@@ -5,6 +5,7 @@
 #include <string>
 #include <iostream>
 #include "DatabaseHandler.hpp"
+#include "SearchIndex.hpp"
 
 using json = nlohmann::json;
 using namespace boost::asio;
@@ -17,15 +18,19 @@ private:
     shared_ptr<ip::tcp::socket> socket;
     string buffer_;
     DatabaseHandler& db_handler_;
+    SearchIndex& search_index_;
     weak_ptr<Connector> connector_;
     string username_;
+    bool compression_ = false;  //     
     void do_read();
     void process_message(const json& msg);
     json handle_auth(const json& msg);
     void handle_message(const json& msg, bool is_team);
+    json handle_search(const json& msg);
+    json handle_sync(const json& msg);
 
 public:
-    Session(shared_ptr<ip::tcp::socket> socket, DatabaseHandler& db_handler);
+    Session(shared_ptr<ip::tcp::socket> socket, DatabaseHandler& db_handler, SearchIndex& search_index);
     void start();
     void set_connector(shared_ptr<Connector> connector) { connector_ = connector; }
     void send_response(const json& response);
@@ -3,10 +3,21 @@
 #include <memory>
 #include "Connector.hpp"
 #include "DatabaseHandler.hpp"
+#include "SearchIndex.hpp"
 
 using namespace boost::asio;
 using namespace std;
 
+//      
+void schedule_index_flush(steady_timer& timer, SearchIndex& search_index) {
+    timer.expires_after(std::chrono::seconds(60));
+    timer.async_wait([&timer, &search_index](const boost::system::error_code& ec) {
+        if (ec) return;
+        search_index.save();
+        schedule_index_flush(timer, search_index);
+    });
+}
+
 int main() {
     setlocale(LC_ALL, "ru");
     unsigned int port = 52777;
@@ -24,8 +35,14 @@ int main() {
             3306
         );
 
+        //     
+        SearchIndex search_index("search_index");
+        search_index.build(db_handler);
+        steady_timer flush_timer(context);
+        schedule_index_flush(flush_timer, search_index);
+
         //    
-        auto connector = make_shared<Connector>(context, port, db_handler);
+        auto connector = make_shared<Connector>(context, port, db_handler, search_index);
         cout << " ,  " << port << endl;
         context.run();
     }